@@ -0,0 +1,30 @@
+#include "pch.h"
+#include "Checkpoint.h"
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+
+bool writeCheckpointHeader(FILE* file)
+{
+	return writeValue(file, (unsigned int)CHECKPOINT_MAGIC) && writeValue(file, (unsigned int)CHECKPOINT_VERSION);
+}
+
+bool readCheckpointHeader(FILE* file)
+{
+	unsigned int magic;
+	unsigned int version;
+
+	return readValue(file, magic) && readValue(file, version) && magic == CHECKPOINT_MAGIC && version == CHECKPOINT_VERSION;
+}
+
+// POSIX rename() replaces an existing target atomically; the Windows CRT rename() refuses
+// to, so there the replacement goes through MoveFileEx.
+bool replaceCheckpoint(const char* source, const char* target)
+{
+#ifdef _WIN32
+	return MoveFileExA(source, target, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	return rename(source, target) == 0;
+#endif
+}
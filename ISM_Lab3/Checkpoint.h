@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdio>
+
+// Binary checkpoints are written field by field in native byte order, so the same state
+// always produces the same bytes and no struct padding leaks into the file.
+
+#define CHECKPOINT_MAGIC    0x54504B43
+#define CHECKPOINT_VERSION  3
+
+bool writeCheckpointHeader(FILE* file);
+bool readCheckpointHeader(FILE* file);
+
+// Moves a finished file over the target in one step: the target is either the old or the
+// new file, never missing.
+bool replaceCheckpoint(const char* source, const char* target);
+
+template<typename T>
+bool writeValue(FILE* file, const T& value)
+{
+	return fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template<typename T>
+bool readValue(FILE* file, T& value)
+{
+	return fread(&value, sizeof(T), 1, file) == 1;
+}
+
+template<typename T>
+bool writeArray(FILE* file, const T* values, int num)
+{
+	return num == 0 || fwrite(values, sizeof(T), num, file) == (size_t)num;
+}
+
+template<typename T>
+bool readArray(FILE* file, T* values, int num)
+{
+	return num == 0 || fread(values, sizeof(T), num, file) == (size_t)num;
+}
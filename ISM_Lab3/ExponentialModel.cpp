@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "ExponentialModel.h"
+#include "Checkpoint.h"
 #include <algorithm>
+#include <cmath>
 
 
 ExponentialModel::ExponentialModel(const PRNG* prng, double lambda) : prng((PRNG*)(prng->clone())), lambda(lambda) {}
@@ -13,9 +15,44 @@ ExponentialModel::~ExponentialModel()
 }
 
 
+template<typename Real>
+Real ExponentialModel::generate() const
+{
+	return -std::log(prng->nextReal<Real>()) / (Real)lambda;
+}
+
 double ExponentialModel::next() const
 {
-	return -log(prng->next()) / lambda;
+	return generate<double>();
+}
+
+float ExponentialModel::nextFloat() const
+{
+	return generate<float>();
+}
+
+// The uniforms are drawn into the buffer in one call and transformed in place with the
+// same expression as generate().
+template<typename Real>
+void ExponentialModel::generateBatch(Real* buffer, int num) const
+{
+	Real realLambda = (Real)lambda;
+
+	prng->fill(buffer, num);
+	for (int i = 0; i < num; i++)
+	{
+		buffer[i] = -std::log(buffer[i]) / realLambda;
+	}
+}
+
+void ExponentialModel::fill(double* buffer, int num) const
+{
+	generateBatch(buffer, num);
+}
+
+void ExponentialModel::fill(float* buffer, int num) const
+{
+	generateBatch(buffer, num);
 }
 
 void ExponentialModel::reset() const
@@ -23,6 +60,28 @@ void ExponentialModel::reset() const
 	prng->reset();
 }
 
+void ExponentialModel::reset(long long seed) const
+{
+	prng->reset(seed);
+}
+
+void ExponentialModel::skip(long long count) const
+{
+	prng->skip(count);
+}
+
+bool ExponentialModel::saveState(FILE* file) const
+{
+	return writeValue(file, lambda) && prng->saveState(file);
+}
+
+bool ExponentialModel::loadState(FILE* file) const
+{
+	double savedLambda;
+
+	return readValue(file, savedLambda) && savedLambda == lambda && prng->loadState(file);
+}
+
 
 ExponentialModel* ExponentialModel::clone() const
 {
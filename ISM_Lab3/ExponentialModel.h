@@ -7,13 +7,25 @@ class ExponentialModel : public PRNG
 private:
 	const PRNG* prng;
 	const double lambda;
+
+	template<typename Real>
+	Real generate() const;
+	template<typename Real>
+	void generateBatch(Real* buffer, int num) const;
 public:
 	ExponentialModel(const PRNG* prng, double lambda);
 	ExponentialModel(const ExponentialModel* source);
 	~ExponentialModel();
 
 	double next() const override;
+	float nextFloat() const override;
+	void fill(double* buffer, int num) const override;
+	void fill(float* buffer, int num) const override;
 	void reset() const override;
+	void reset(long long seed) const override;
+	void skip(long long count) const override;
+	bool saveState(FILE* file) const override;
+	bool loadState(FILE* file) const override;
 
 	ExponentialModel* clone() const override;
 };
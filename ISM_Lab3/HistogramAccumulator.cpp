@@ -0,0 +1,86 @@
+#include "pch.h"
+#include "HistogramAccumulator.h"
+#include "Checkpoint.h"
+#include <algorithm>
+
+
+HistogramAccumulator::HistogramAccumulator(const double* borders, int cellNum) : cellNum(cellNum)
+{
+	this->borders = new double[cellNum - 1];
+	std::copy(borders, &borders[cellNum - 1], this->borders);
+	counts = new long long[cellNum];
+	std::fill(counts, &counts[cellNum], 0);
+}
+
+HistogramAccumulator::HistogramAccumulator(const HistogramAccumulator* source) : cellNum(source->cellNum)
+{
+	borders = new double[cellNum - 1];
+	std::copy(source->borders, &source->borders[cellNum - 1], borders);
+	counts = new long long[cellNum];
+	std::copy(source->counts, &source->counts[cellNum], counts);
+}
+
+HistogramAccumulator::~HistogramAccumulator()
+{
+	delete[] borders;
+	delete[] counts;
+}
+
+
+void HistogramAccumulator::add(double value)
+{
+	counts[std::upper_bound(borders, &borders[cellNum - 1], value) - borders]++;
+}
+
+bool HistogramAccumulator::merge(const HistogramAccumulator* other)
+{
+	if (other->cellNum != cellNum || !std::equal(borders, &borders[cellNum - 1], other->borders))
+	{
+		return false;
+	}
+
+	for (int i = 0; i < cellNum; i++)
+	{
+		counts[i] += other->counts[i];
+	}
+	return true;
+}
+
+
+int HistogramAccumulator::getCellNum() const
+{
+	return cellNum;
+}
+
+long long HistogramAccumulator::getCount(int cell) const
+{
+	return counts[cell];
+}
+
+// Border between the cells index - 1 and index, 0 < index < cellNum.
+double HistogramAccumulator::getBorder(int index) const
+{
+	return borders[index - 1];
+}
+
+
+bool HistogramAccumulator::saveState(FILE* file) const
+{
+	return writeValue(file, cellNum) && writeArray(file, borders, cellNum - 1) && writeArray(file, counts, cellNum);
+}
+
+bool HistogramAccumulator::loadState(FILE* file)
+{
+	int savedCellNum;
+
+	if (!readValue(file, savedCellNum) || savedCellNum != cellNum)
+	{
+		return false;
+	}
+
+	double* savedBorders = new double[cellNum - 1];
+	bool isSame = readArray(file, savedBorders, cellNum - 1) && std::equal(borders, &borders[cellNum - 1], savedBorders);
+
+	delete[] savedBorders;
+	return isSame && readArray(file, counts, cellNum);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdio>
+
+
+// Fixed-border histogram: the cellNum - 1 inner borders are known before any value arrives,
+// so partial histograms of disjoint streams merge by adding counts. The first and the last
+// cells are open and take the tails.
+class HistogramAccumulator
+{
+private:
+	const int cellNum;
+
+	double* borders;
+	long long* counts;
+public:
+	HistogramAccumulator(const double* borders, int cellNum);
+	HistogramAccumulator(const HistogramAccumulator* source);
+	~HistogramAccumulator();
+
+	void add(double value);
+	bool merge(const HistogramAccumulator* other);
+
+	int getCellNum() const;
+	long long getCount(int cell) const;
+	double getBorder(int index) const;
+
+	bool saveState(FILE* file) const;
+	bool loadState(FILE* file);
+};
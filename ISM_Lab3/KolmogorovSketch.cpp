@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "KolmogorovSketch.h"
+#include "Checkpoint.h"
+#include <algorithm>
+#include <cmath>
+
+
+KolmogorovSketch::KolmogorovSketch(int binNum) : binNum(binNum), total(0)
+{
+	counts = new long long[binNum];
+	std::fill(counts, &counts[binNum], 0);
+}
+
+KolmogorovSketch::KolmogorovSketch(const KolmogorovSketch* source) : binNum(source->binNum), total(source->total)
+{
+	counts = new long long[binNum];
+	std::copy(source->counts, &source->counts[binNum], counts);
+}
+
+KolmogorovSketch::~KolmogorovSketch()
+{
+	delete[] counts;
+}
+
+
+void KolmogorovSketch::add(double cdfValue)
+{
+	int bin = (int)(cdfValue * binNum);
+
+	counts[std::max(0, std::min(bin, binNum - 1))]++;
+	total++;
+}
+
+bool KolmogorovSketch::merge(const KolmogorovSketch* other)
+{
+	if (other->binNum != binNum)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < binNum; i++)
+	{
+		counts[i] += other->counts[i];
+	}
+	total += other->total;
+	return true;
+}
+
+
+long long KolmogorovSketch::getCount() const
+{
+	return total;
+}
+
+double KolmogorovSketch::calcDistance() const
+{
+	double result = 0.0;
+	long long cumulative = 0;
+
+	for (int i = 0; i < binNum; i++)
+	{
+		cumulative += counts[i];
+		result = std::max(result, std::abs((double)cumulative / total - (double)(i + 1) / binNum));
+	}
+
+	return result;
+}
+
+
+bool KolmogorovSketch::saveState(FILE* file) const
+{
+	return writeValue(file, binNum) && writeValue(file, total) && writeArray(file, counts, binNum);
+}
+
+bool KolmogorovSketch::loadState(FILE* file)
+{
+	int savedBinNum;
+
+	return readValue(file, savedBinNum) && savedBinNum == binNum && readValue(file, total) && readArray(file, counts, binNum);
+}
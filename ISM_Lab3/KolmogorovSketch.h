@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdio>
+
+#define KOLMOGOROV_SKETCH_SIZE  65536
+
+
+// Histogram of the theoretical CDF values F(x) of the samples over [0, 1]. The empirical
+// CDF is known exactly at every bin edge, and the distance is taken over the edges only.
+// For a sample that follows F this misses the deviation inside one bin, which changes the
+// scaled statistic sqrt(n) * D by about 1 / sqrt(binNum) (0.004 for the default size)
+// independently of n.
+class KolmogorovSketch
+{
+private:
+	const int binNum;
+
+	long long* counts;
+	long long total;
+public:
+	KolmogorovSketch(int binNum);
+	KolmogorovSketch(const KolmogorovSketch* source);
+	~KolmogorovSketch();
+
+	void add(double cdfValue);
+	bool merge(const KolmogorovSketch* other);
+
+	long long getCount() const;
+	double calcDistance() const;
+
+	bool saveState(FILE* file) const;
+	bool loadState(FILE* file);
+};
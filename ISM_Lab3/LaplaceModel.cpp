@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "LaplaceModel.h"
+#include "Checkpoint.h"
 #include <algorithm>
+#include <cmath>
 
 LaplaceModel::LaplaceModel(const PRNG* prng, double lambda) : prng((PRNG*)(prng->clone())), lambda(lambda) {}
 
@@ -12,10 +14,47 @@ LaplaceModel::~LaplaceModel()
 }
 
 
+template<typename Real>
+Real LaplaceModel::generate() const
+{
+	Real randomValue = prng->nextReal<Real>();
+	Real realLambda = (Real)lambda;
+	return (randomValue < (Real)0.5) ? std::log((Real)2.0 * randomValue) / realLambda : -std::log((Real)2.0 * ((Real)1.0 - randomValue)) / realLambda;
+}
+
 double LaplaceModel::next() const
 {
-	double randomValue = prng->next();
-	return (randomValue < 0.5) ? log(2.0 * randomValue) / lambda : -log(2.0 * (1.0 - randomValue)) / lambda;
+	return generate<double>();
+}
+
+float LaplaceModel::nextFloat() const
+{
+	return generate<float>();
+}
+
+// The uniforms are drawn into the buffer in one call and transformed in place with the
+// same expression as generate().
+template<typename Real>
+void LaplaceModel::generateBatch(Real* buffer, int num) const
+{
+	Real realLambda = (Real)lambda;
+
+	prng->fill(buffer, num);
+	for (int i = 0; i < num; i++)
+	{
+		Real randomValue = buffer[i];
+		buffer[i] = (randomValue < (Real)0.5) ? std::log((Real)2.0 * randomValue) / realLambda : -std::log((Real)2.0 * ((Real)1.0 - randomValue)) / realLambda;
+	}
+}
+
+void LaplaceModel::fill(double* buffer, int num) const
+{
+	generateBatch(buffer, num);
+}
+
+void LaplaceModel::fill(float* buffer, int num) const
+{
+	generateBatch(buffer, num);
 }
 
 void LaplaceModel::reset() const
@@ -23,6 +62,28 @@ void LaplaceModel::reset() const
 	prng->reset();
 }
 
+void LaplaceModel::reset(long long seed) const
+{
+	prng->reset(seed);
+}
+
+void LaplaceModel::skip(long long count) const
+{
+	prng->skip(count);
+}
+
+bool LaplaceModel::saveState(FILE* file) const
+{
+	return writeValue(file, lambda) && prng->saveState(file);
+}
+
+bool LaplaceModel::loadState(FILE* file) const
+{
+	double savedLambda;
+
+	return readValue(file, savedLambda) && savedLambda == lambda && prng->loadState(file);
+}
+
 
 LaplaceModel* LaplaceModel::clone() const
 {
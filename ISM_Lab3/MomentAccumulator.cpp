@@ -0,0 +1,87 @@
+#include "pch.h"
+#include "MomentAccumulator.h"
+#include "Checkpoint.h"
+#include <algorithm>
+
+
+MomentAccumulator::MomentAccumulator() : count(0), mean(0.0), m2(0.0), minValue(0.0), maxValue(0.0) {}
+
+MomentAccumulator::MomentAccumulator(const MomentAccumulator* source)
+	: count(source->count), mean(source->mean), m2(source->m2), minValue(source->minValue), maxValue(source->maxValue) {}
+
+MomentAccumulator::~MomentAccumulator()
+= default;
+
+
+// Welford's update keeps the variance accurate over billions of values.
+void MomentAccumulator::add(double value)
+{
+	double delta = value - mean;
+
+	count++;
+	mean += delta / count;
+	m2 += delta * (value - mean);
+
+	minValue = (count == 1) ? value : std::min(minValue, value);
+	maxValue = (count == 1) ? value : std::max(maxValue, value);
+}
+
+// Chan's pairwise combination. The result agrees with a sequential pass to rounding.
+void MomentAccumulator::merge(const MomentAccumulator* other)
+{
+	if (other->count == 0)
+	{
+		return;
+	}
+	if (count == 0)
+	{
+		*this = *other;
+		return;
+	}
+
+	long long total = count + other->count;
+	double delta = other->mean - mean;
+
+	mean += delta * other->count / total;
+	m2 += other->m2 + delta * delta * ((double)count * other->count / total);
+	minValue = std::min(minValue, other->minValue);
+	maxValue = std::max(maxValue, other->maxValue);
+	count = total;
+}
+
+
+long long MomentAccumulator::getCount() const
+{
+	return count;
+}
+
+double MomentAccumulator::getMean() const
+{
+	return mean;
+}
+
+double MomentAccumulator::getVariance() const
+{
+	return (count > 1) ? m2 / (count - 1) : 0.0;
+}
+
+double MomentAccumulator::getMin() const
+{
+	return minValue;
+}
+
+double MomentAccumulator::getMax() const
+{
+	return maxValue;
+}
+
+
+bool MomentAccumulator::saveState(FILE* file) const
+{
+	return writeValue(file, count) && writeValue(file, mean) && writeValue(file, m2) && writeValue(file, minValue) && writeValue(file, maxValue);
+}
+
+bool MomentAccumulator::loadState(FILE* file)
+{
+	return readValue(file, count) && readValue(file, mean) && readValue(file, m2) && readValue(file, minValue) && readValue(file, maxValue);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdio>
+
+
+class MomentAccumulator
+{
+private:
+	long long count;
+	double mean;
+	double m2;
+	double minValue;
+	double maxValue;
+public:
+	MomentAccumulator();
+	MomentAccumulator(const MomentAccumulator* source);
+	~MomentAccumulator();
+
+	void add(double value);
+	void merge(const MomentAccumulator* other);
+
+	long long getCount() const;
+	double getMean() const;
+	double getVariance() const;
+	double getMin() const;
+	double getMax() const;
+
+	bool saveState(FILE* file) const;
+	bool loadState(FILE* file);
+};
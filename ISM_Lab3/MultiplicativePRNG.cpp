@@ -1,12 +1,94 @@
 ﻿#include "pch.h"
 #include "MultiplicativePRNG.h"
+#include "Checkpoint.h"
 
-MultiplicativePRNG::MultiplicativePRNG(long long module, long long seed, int multiplier) : module(module), multiplier(multiplier), seed(seed)
+// Number of low state bits dropped by nextFloat(), so that at most 2^23 distinct cells remain.
+static int calcFloatShift(long long module)
+{
+	int shift = 0;
+
+	while (((module - 1) >> shift) >= (1LL << 23))
+	{
+		shift++;
+	}
+
+	return shift;
+}
+
+// base^exponent (mod module) by squaring. Products stay below module^2, which fits for
+// moduli up to 2^31.
+static long long calcPower(long long base, long long exponent, long long module)
+{
+	long long power = base % module;
+	long long result = 1 % module;
+
+	while (exponent > 0)
+	{
+		if (exponent & 1)
+		{
+			result = (result * power) % module;
+		}
+		power = (power * power) % module;
+		exponent >>= 1;
+	}
+
+	return result;
+}
+
+static long long calcGCD(long long first, long long second)
+{
+	while (second != 0)
+	{
+		long long rest = first % second;
+		first = second;
+		second = rest;
+	}
+
+	return first;
+}
+
+// Carmichael function: the largest multiplicative order modulo module, found by factoring
+// module with trial division.
+static long long calcCarmichael(long long module)
+{
+	long long result = 1;
+
+	for (long long p = 2; module > 1; p++)
+	{
+		if (p * p > module)
+		{
+			p = module;
+		}
+		if (module % p != 0)
+		{
+			continue;
+		}
+
+		long long power = 1;
+		int exponent = 0;
+		while (module % p == 0)
+		{
+			module /= p;
+			power *= p;
+			exponent++;
+		}
+
+		long long lambda = (p == 2 && exponent >= 3) ? power / 4 : power / p * (p - 1);
+		result = result / calcGCD(result, lambda) * lambda;
+	}
+
+	return result;
+}
+
+
+MultiplicativePRNG::MultiplicativePRNG(long long module, long long seed, int multiplier)
+	: module(module), multiplier(multiplier), seed(seed), floatShift(calcFloatShift(module)), floatModule(((module - 1) >> calcFloatShift(module)) + 1)
 {
 	this->last = seed;
 }
 
-MultiplicativePRNG::MultiplicativePRNG(const MultiplicativePRNG* source) : module(source->module), multiplier(source->multiplier), seed(source->seed)
+MultiplicativePRNG::MultiplicativePRNG(const MultiplicativePRNG* source)
+	: module(source->module), multiplier(source->multiplier), seed(source->seed), floatShift(source->floatShift), floatModule(source->floatModule)
 {
 	this->last = source->last;
 }
@@ -20,12 +102,144 @@ double MultiplicativePRNG::next() const
 	return (double)last / module;
 }
 
+long long MultiplicativePRNG::nextInteger() const
+{
+	last = (last * multiplier) % module;
+	return last;
+}
+
+// Keeps the upper bits of the state (at most 2^23 cells, whatever the module) and centers
+// the value in its cell, so the result stays strictly inside (0, 1) after rounding to float:
+// the largest value is 1 - 0.5 / floatModule >= 1 - 2^-24. The dropped low bits are the
+// weakest ones of a power-of-two modulus.
+float MultiplicativePRNG::nextFloat() const
+{
+	last = (last * multiplier) % module;
+	return (float)(((double)(last >> floatShift) + 0.5) / floatModule);
+}
+
+void MultiplicativePRNG::fill(double* buffer, int num) const
+{
+	long long state = last;
+
+	for (int i = 0; i < num; i++)
+	{
+		state = (state * multiplier) % module;
+		buffer[i] = (double)state / module;
+	}
+
+	last = state;
+}
+
+void MultiplicativePRNG::fill(float* buffer, int num) const
+{
+	long long state = last;
+
+	for (int i = 0; i < num; i++)
+	{
+		state = (state * multiplier) % module;
+		buffer[i] = (float)(((double)(state >> floatShift) + 0.5) / floatModule);
+	}
+
+	last = state;
+}
+
 void MultiplicativePRNG::reset() const
 {
 	last = seed;
 }
 
+// Restarts the stream from a new seed, which later reset() calls and checkpoints keep.
+void MultiplicativePRNG::reset(long long seed) const
+{
+	this->seed = seed;
+	last = seed;
+}
+
+// Jumps ahead by multiplying the state with multiplier^count (mod module).
+void MultiplicativePRNG::skip(long long count) const
+{
+	last = (last * calcPower(multiplier, count, module)) % module;
+}
+
+// The state returns to last after n steps exactly when multiplier^n = 1 modulo
+// module / gcd(last, module), so the period is the multiplicative order of the multiplier
+// there. The order divides the Carmichael function, which is reduced prime by prime.
+// Returns 0 when the multiplier shares a factor with the module: the stream is then not
+// purely periodic.
+long long MultiplicativePRNG::calcPeriod() const
+{
+	long long reduced = module / calcGCD(last, module);
+	long long order;
+	long long rest;
+
+	if (calcGCD(multiplier, module) != 1)
+	{
+		return 0;
+	}
+
+	order = calcCarmichael(reduced);
+	rest = order;
+	for (long long p = 2; rest > 1; p++)
+	{
+		if (p * p > rest)
+		{
+			p = rest;
+		}
+		if (rest % p != 0)
+		{
+			continue;
+		}
+
+		while (rest % p == 0)
+		{
+			rest /= p;
+		}
+		while (order % p == 0 && calcPower(multiplier, order / p, reduced) == 1 % reduced)
+		{
+			order /= p;
+		}
+	}
+
+	return order;
+}
+
+bool MultiplicativePRNG::saveState(FILE* file) const
+{
+	return writeValue(file, module) && writeValue(file, seed) && writeValue(file, multiplier) && writeValue(file, last);
+}
+
+bool MultiplicativePRNG::loadState(FILE* file) const
+{
+	long long savedModule;
+	long long savedSeed;
+	int savedMultiplier;
+	long long savedLast;
+
+	if (!readValue(file, savedModule) || !readValue(file, savedSeed) || !readValue(file, savedMultiplier) || !readValue(file, savedLast))
+	{
+		return false;
+	}
+	if (savedModule != module || savedSeed != seed || savedMultiplier != multiplier)
+	{
+		return false;
+	}
+
+	last = savedLast;
+	return true;
+}
+
 MultiplicativePRNG* MultiplicativePRNG::clone() const
 {
 	return new MultiplicativePRNG(this);
 }
+
+long long MultiplicativePRNG::getModule() const
+{
+	return module;
+}
+
+int MultiplicativePRNG::getMultiplier() const
+{
+	return multiplier;
+}
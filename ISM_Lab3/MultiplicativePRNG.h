@@ -5,9 +5,11 @@ class MultiplicativePRNG : public PRNG
 {
 private:
 	const long long module;
-	const long long seed;
 	const int multiplier;
+	const int floatShift;
+	const long long floatModule;
 
+	mutable long long seed;
 	mutable long long last;
 public:
 	MultiplicativePRNG(long long module, long long seed, int multiplier);
@@ -15,7 +17,20 @@ public:
 	~MultiplicativePRNG();
 
 	double next() const override;
+	float nextFloat() const override;
+	long long nextInteger() const;
+	void fill(double* buffer, int num) const override;
+	void fill(float* buffer, int num) const override;
 	void reset() const override;
+	void reset(long long seed) const override;
+	void skip(long long count) const override;
+	bool saveState(FILE* file) const override;
+	bool loadState(FILE* file) const override;
 	MultiplicativePRNG* clone() const override;
+
+	long long calcPeriod() const;
+
+	long long getModule() const;
+	int getMultiplier() const;
 };
 
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "NormalKernel.h"
+#include <cmath>
+
+
+// GCC merges sin and cos of the same angle into one sincos call, which has no vector
+// variant, so the two outputs are computed in separate loops over the saved radius.
+template<typename Real>
+void generateBoxMuller(Real* first, Real* second, Real* radius, int pairNum, Real mean, Real deviation)
+{
+	NORMAL_SIMD_LOOP
+	for (int i = 0; i < pairNum; i++)
+	{
+		radius[i] = std::sqrt((Real)-2.0 * std::log(first[i]));
+	}
+
+	NORMAL_SIMD_LOOP
+	for (int i = 0; i < pairNum; i++)
+	{
+		first[i] = mean + deviation * (radius[i] * std::cos((Real)(2.0 * M_PI) * second[i]));
+	}
+
+	NORMAL_SIMD_LOOP
+	for (int i = 0; i < pairNum; i++)
+	{
+		second[i] = mean + deviation * (radius[i] * std::sin((Real)(2.0 * M_PI) * second[i]));
+	}
+}
+
+template<typename Real>
+bool isPolarAccepted(Real s)
+{
+	return s > (Real)0.0 && s < (Real)1.0;
+}
+
+template<typename Real>
+Real calcPolarFactor(Real s)
+{
+	return std::sqrt((Real)-2.0 * std::log(s) / s);
+}
+
+// Rejected candidates get s = 0.5 to keep the math finite. The compaction stores every
+// pair and moves the write position only past accepted ones: it has no branches, but the
+// store address depends on the data, so that loop stays scalar.
+template<typename Real>
+int generatePolar(Real* first, Real* second, Real* mask, int candidateNum, Real* result, Real mean, Real deviation)
+{
+	int acceptedNum = 0;
+
+	NORMAL_SIMD_LOOP
+	for (int i = 0; i < candidateNum; i++)
+	{
+		Real v1 = (Real)2.0 * first[i] - (Real)1.0;
+		Real v2 = (Real)2.0 * second[i] - (Real)1.0;
+		Real s = v1 * v1 + v2 * v2;
+		bool isAccepted = isPolarAccepted(s);
+		Real factor = calcPolarFactor(isAccepted ? s : (Real)0.5);
+
+		first[i] = mean + deviation * (v1 * factor);
+		second[i] = mean + deviation * (v2 * factor);
+		mask[i] = isAccepted ? (Real)1.0 : (Real)0.0;
+	}
+
+	for (int i = 0; i < candidateNum; i++)
+	{
+		result[2 * acceptedNum] = first[i];
+		result[2 * acceptedNum + 1] = second[i];
+		acceptedNum += (int)mask[i];
+	}
+
+	return acceptedNum;
+}
+
+
+template void generateBoxMuller<float>(float*, float*, float*, int, float, float);
+template void generateBoxMuller<double>(double*, double*, double*, int, double, double);
+template int generatePolar<float>(float*, float*, float*, int, float*, float, float);
+template int generatePolar<double>(double*, double*, double*, int, double*, double, double);
+template bool isPolarAccepted<float>(float);
+template bool isPolarAccepted<double>(double);
+template float calcPolarFactor<float>(float);
+template double calcPolarFactor<double>(double);
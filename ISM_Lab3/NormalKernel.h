@@ -0,0 +1,51 @@
+#pragma once
+
+#define NORMAL_BATCH_SIZE   512
+
+enum NormalMethod
+{
+	NORMAL_BOX_MULLER,
+	NORMAL_POLAR
+};
+
+// Marks the kernel loops as free of aliasing between the buffers. The transcendental calls
+// vectorize only against a vector math library, which the compilers use only with relaxed
+// floating point:
+//   GCC   - -O3 -ffast-math (glibc libmvec on x86-64), check with -fopt-info-vec;
+//   Clang - -O3 -ffast-math -fveclib=libmvec, check with -Rpass=loop-vectorize;
+//   MSVC  - /O2 /fp:fast (SVML), check with /Qvec-report:2.
+// Without them the loops stay scalar and the kernels give the same values, bit for bit, as
+// NormalModel::next(). Vector math changes the last bits.
+#if defined(_MSC_VER)
+#define NORMAL_SIMD_LOOP    __pragma(loop(ivdep))
+#elif defined(__clang__)
+#define NORMAL_SIMD_LOOP    _Pragma("clang loop vectorize(enable)")
+#elif defined(__GNUC__)
+#define NORMAL_SIMD_LOOP    _Pragma("GCC ivdep")
+#else
+#define NORMAL_SIMD_LOOP
+#endif
+
+
+// Stateless normal kernels over split buffers: first[i] and second[i] are the two uniforms
+// of pair i. They keep no state between calls, so any number of threads may run them at
+// once on their own buffers.
+
+// Turns pairNum pairs of uniforms into pairNum pairs of normal values in place; radius is
+// scratch space for pairNum values.
+template<typename Real>
+void generateBoxMuller(Real* first, Real* second, Real* radius, int pairNum, Real mean, Real deviation);
+
+// Marsaglia's polar method over candidateNum pairs of uniforms. Every candidate is evaluated
+// in place without branches, and mask[i] is set to 1 for accepted candidates, 0 otherwise.
+// The accepted pairs are then written to result interleaved, in order. Returns the number
+// of accepted pairs; result must hold 2 * candidateNum.
+template<typename Real>
+int generatePolar(Real* first, Real* second, Real* mask, int candidateNum, Real* result, Real mean, Real deviation);
+
+// Shared with the scalar path so that both produce identical values for s = v1^2 + v2^2.
+template<typename Real>
+bool isPolarAccepted(Real s);
+
+template<typename Real>
+Real calcPolarFactor(Real s);
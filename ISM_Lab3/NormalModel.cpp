@@ -1,16 +1,19 @@
 #include "pch.h"
 #include "NormalModel.h"
+#include "Checkpoint.h"
 #include <algorithm>
 #include <cmath>
 
 
-NormalModel::NormalModel(const PRNG* prng, double mean, double variance) : prng((PRNG*)(prng->clone())), mean(mean), variance(variance)
+NormalModel::NormalModel(const PRNG* prng, double mean, double variance, NormalMethod method)
+	: prng((PRNG*)(prng->clone())), mean(mean), variance(variance), method(method)
 {
 	cachedValue = 0.0;
 	isCached = false;
 }
 
-NormalModel::NormalModel(const NormalModel* source) : prng((PRNG*)(source->prng->clone())), mean(source->mean), variance(source->variance)
+NormalModel::NormalModel(const NormalModel* source)
+	: prng((PRNG*)(source->prng->clone())), mean(source->mean), variance(source->variance), method(source->method)
 {
 	this->cachedValue = source->cachedValue;
 	this->isCached = source->isCached;
@@ -22,35 +25,195 @@ NormalModel::~NormalModel()
 }
 
 
-double NormalModel::next() const
+template<typename Real>
+Real NormalModel::generate() const
 {
-	double result;
+	Real result;
+
+	if(!isCached && method == NORMAL_POLAR)
+	{
+		Real v1;
+		Real v2;
+		Real s;
+		Real deviation = std::sqrt((Real)variance);
+
+		do
+		{
+			v1 = (Real)2.0 * prng->nextReal<Real>() - (Real)1.0;
+			v2 = (Real)2.0 * prng->nextReal<Real>() - (Real)1.0;
+			s = v1 * v1 + v2 * v2;
+		}
+		while (!isPolarAccepted(s));
 
-	if(!isCached)
+		Real factor = calcPolarFactor(s);
+
+		result = (Real)mean + deviation * (v1 * factor);
+		cachedValue = (Real)mean + deviation * (v2 * factor);
+		isCached = true;
+	}
+	else if(!isCached)
 	{
-		double mul = sqrt(-2.0 * log(prng->next()));
-		double ang = 2.0 * M_PI * prng->next();
-		double deviation = sqrt(variance);
+		Real mul = std::sqrt((Real)-2.0 * std::log(prng->nextReal<Real>()));
+		Real ang = (Real)(2.0 * M_PI) * prng->nextReal<Real>();
+		Real deviation = std::sqrt((Real)variance);
 
-		result = mean + deviation * (mul * cos(ang));
-		cachedValue = mean + deviation * (mul * sin(ang));
+		result = (Real)mean + deviation * (mul * std::cos(ang));
+		cachedValue = (Real)mean + deviation * (mul * std::sin(ang));
 		isCached = true;
 	}
 	else
 	{
-		result = cachedValue;
+		result = (Real)cachedValue;
 		isCached = false;
 	}
 
 	return result;
 }
 
+double NormalModel::next() const
+{
+	return generate<double>();
+}
+
+float NormalModel::nextFloat() const
+{
+	return generate<float>();
+}
+
+// Whole pairs go through the batched kernels straight into the buffer. The cache is only
+// touched at the ends of an odd request, so the output matches repeated next() calls.
+// The polar method asks for exactly as many candidates as pairs are still missing, which
+// never draws uniforms beyond the ones the scalar path would use.
+template<typename Real>
+void NormalModel::generateBatch(Real* buffer, int num) const
+{
+	Real first[NORMAL_BATCH_SIZE];
+	Real second[NORMAL_BATCH_SIZE];
+	Real scratch[NORMAL_BATCH_SIZE];
+	Real realMean = (Real)mean;
+	Real deviation = std::sqrt((Real)variance);
+	int done = 0;
+
+	if (num > 0 && isCached)
+	{
+		buffer[done++] = (Real)cachedValue;
+		isCached = false;
+	}
+
+	// The uniforms are drawn in stream order into the output and split into the kernels'
+	// layout; Box-Muller pairs are then interleaved back in place.
+	while (num - done >= 2)
+	{
+		int pairNum = std::min((num - done) / 2, NORMAL_BATCH_SIZE);
+		Real* pairs = &buffer[done];
+
+		prng->fill(pairs, 2 * pairNum);
+		for (int i = 0; i < pairNum; i++)
+		{
+			first[i] = pairs[2 * i];
+			second[i] = pairs[2 * i + 1];
+		}
+
+		if (method == NORMAL_POLAR)
+		{
+			done += 2 * generatePolar(first, second, scratch, pairNum, pairs, realMean, deviation);
+		}
+		else
+		{
+			generateBoxMuller(first, second, scratch, pairNum, realMean, deviation);
+			for (int i = 0; i < pairNum; i++)
+			{
+				pairs[2 * i] = first[i];
+				pairs[2 * i + 1] = second[i];
+			}
+			done += 2 * pairNum;
+		}
+	}
+
+	if (done < num)
+	{
+		buffer[done] = generate<Real>();
+	}
+}
+
+void NormalModel::fill(double* buffer, int num) const
+{
+	generateBatch(buffer, num);
+}
+
+void NormalModel::fill(float* buffer, int num) const
+{
+	generateBatch(buffer, num);
+}
+
 void NormalModel::reset() const
 {
 	prng->reset();
 	isCached = false;
 }
 
+void NormalModel::reset(long long seed) const
+{
+	prng->reset(seed);
+	isCached = false;
+}
+
+// Every Box-Muller pair takes two uniforms. An odd count ends in the middle of a pair,
+// whose second value is generated and cached exactly as next() would. The polar method
+// takes a random number of uniforms per pair, so it has to generate and drop the values.
+void NormalModel::skip(long long count) const
+{
+	if (count > 0 && isCached)
+	{
+		isCached = false;
+		count--;
+	}
+
+	if (method == NORMAL_POLAR)
+	{
+		for (long long i = 0; i < count; i++)
+		{
+			next();
+		}
+		return;
+	}
+
+	prng->skip(count / 2 * 2);
+	if (count % 2 != 0)
+	{
+		next();
+	}
+}
+
+bool NormalModel::saveState(FILE* file) const
+{
+	return writeValue(file, mean) && writeValue(file, variance) && writeValue(file, (int)method) && writeValue(file, cachedValue)
+		&& writeValue(file, (unsigned char)isCached) && prng->saveState(file);
+}
+
+bool NormalModel::loadState(FILE* file) const
+{
+	double savedMean;
+	double savedVariance;
+	int savedMethod;
+	double savedCachedValue;
+	unsigned char savedIsCached;
+
+	if (!readValue(file, savedMean) || !readValue(file, savedVariance) || !readValue(file, savedMethod)
+		|| !readValue(file, savedCachedValue) || !readValue(file, savedIsCached))
+	{
+		return false;
+	}
+	if (savedMean != mean || savedVariance != variance || savedMethod != (int)method || !prng->loadState(file))
+	{
+		return false;
+	}
+
+	cachedValue = savedCachedValue;
+	isCached = (savedIsCached != 0);
+	return true;
+}
+
 
 NormalModel* NormalModel::clone() const
 {
@@ -1,5 +1,6 @@
 #pragma once
 #include "PRNG.h"
+#include "NormalKernel.h"
 
 
 class NormalModel : public PRNG
@@ -8,16 +9,29 @@ private:
 	const PRNG* prng;
 	const double mean;
 	const double variance;
+	const NormalMethod method;
 
 	mutable double cachedValue;
 	mutable bool isCached;
+
+	template<typename Real>
+	Real generate() const;
+	template<typename Real>
+	void generateBatch(Real* buffer, int num) const;
 public:
-	NormalModel(const PRNG* prng, double mean, double variance);
+	NormalModel(const PRNG* prng, double mean, double variance, NormalMethod method = NORMAL_BOX_MULLER);
 	NormalModel(const NormalModel* normalModel);
 	~NormalModel();
 
 	double next() const override;
+	float nextFloat() const override;
+	void fill(double* buffer, int num) const override;
+	void fill(float* buffer, int num) const override;
 	void reset() const override;
+	void reset(long long seed) const override;
+	void skip(long long count) const override;
+	bool saveState(FILE* file) const override;
+	bool loadState(FILE* file) const override;
 
 	NormalModel* clone() const override;
 };
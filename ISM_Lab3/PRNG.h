@@ -1,10 +1,72 @@
 #pragma once
 #include "Cloneable.h"
+#include <cstdio>
+
+#define PRNG_CHUNK_SIZE     1024
 
 class PRNG : public Cloneable
 {
 public:
 	virtual double next() const = 0;
+	virtual float nextFloat() const = 0;
 	virtual void reset() const = 0;
+	virtual void reset(long long seed) const = 0;
+	virtual void skip(long long count) const = 0;
+
+	virtual bool saveState(FILE* file) const = 0;
+	virtual bool loadState(FILE* file) const = 0;
+
+	virtual void fill(double* buffer, int num) const;
+	virtual void fill(float* buffer, int num) const;
+	void fillRounded(float* buffer, int num) const;
+
+	template<typename Real>
+	Real nextReal() const;
 };
 
+
+template<>
+inline double PRNG::nextReal<double>() const
+{
+	return next();
+}
+
+template<>
+inline float PRNG::nextReal<float>() const
+{
+	return nextFloat();
+}
+
+inline void PRNG::fill(double* buffer, int num) const
+{
+	for (int i = 0; i < num; i++)
+	{
+		buffer[i] = next();
+	}
+}
+
+inline void PRNG::fill(float* buffer, int num) const
+{
+	for (int i = 0; i < num; i++)
+	{
+		buffer[i] = nextFloat();
+	}
+}
+
+// Mixed precision: values are generated in double through fill() in chunks and only
+// rounded for storage.
+inline void PRNG::fillRounded(float* buffer, int num) const
+{
+	double chunk[PRNG_CHUNK_SIZE];
+
+	for (int done = 0; done < num; done += PRNG_CHUNK_SIZE)
+	{
+		int chunkNum = (num - done < PRNG_CHUNK_SIZE) ? num - done : PRNG_CHUNK_SIZE;
+
+		fill(chunk, chunkNum);
+		for (int i = 0; i < chunkNum; i++)
+		{
+			buffer[done + i] = (float)chunk[i];
+		}
+	}
+}
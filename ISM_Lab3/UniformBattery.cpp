@@ -0,0 +1,517 @@
+#include "pch.h"
+#include "UniformBattery.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+static const int lags[BATTERY_LAG_NUM] = {1, 2, 3, 4, 5, 8, 16, 64};
+
+// Signed 128-bit integer in two words, as MSVC has no built-in one.
+struct ExactSum
+{
+	unsigned long long low;
+	long long high;
+};
+
+struct BatteryBlock
+{
+	long long begin;
+	long long end;
+
+	ExactSum lagSums[BATTERY_LAG_NUM];
+	long long lagCounts[BATTERY_LAG_NUM];
+
+	long long aboveNum;
+	long long transitionNum;
+
+	long long gapCounts[BATTERY_GAP_LENGTHS + 1];
+	long long leadingGap;
+	long long trailingGap;
+	bool hasHit;
+
+	long long pokerCounts[BATTERY_POKER_HAND + 1];
+	long long bitCounts[BATTERY_MAX_BITS];
+};
+
+
+static void addExact(ExactSum* sum, long long value)
+{
+	unsigned long long low = sum->low + (unsigned long long)value;
+
+	sum->high += ((value < 0) ? -1 : 0) + ((low < sum->low) ? 1 : 0);
+	sum->low = low;
+}
+
+static void mergeExact(ExactSum* sum, const ExactSum& other)
+{
+	unsigned long long low = sum->low + other.low;
+
+	sum->high += other.high + ((low < sum->low) ? 1 : 0);
+	sum->low = low;
+}
+
+static double convertExact(const ExactSum& sum)
+{
+	return (double)sum.high * 18446744073709551616.0 + (double)sum.low;
+}
+
+static void printResult(FILE* outputFile, const char* name, double statistic, double pValue)
+{
+	printf("%-28s statistic %12.4f  p-value %.6f\n", name, statistic, pValue);
+	fprintf(outputFile, "%-28s statistic %12.4f  p-value %.6f\n", name, statistic, pValue);
+}
+
+static double calcNormalPValue(double z)
+{
+	return erfc(std::abs(z) / sqrt(2.0));
+}
+
+// Regularized upper incomplete gamma function Q(a, x): series for small x, Lentz's
+// continued fraction otherwise.
+static double calcGammaQ(double a, double x)
+{
+	const int iterationNum = 1000;
+	const double epsilon = 1e-15;
+	const double tiny = 1e-300;
+
+	if (x <= 0.0)
+	{
+		return 1.0;
+	}
+
+	if (x < a + 1.0)
+	{
+		double term = 1.0 / a;
+		double sum = term;
+
+		for (int i = 1; i < iterationNum && std::abs(term) > std::abs(sum) * epsilon; i++)
+		{
+			term *= x / (a + i);
+			sum += term;
+		}
+		return 1.0 - sum * exp(-x + a * log(x) - lgamma(a));
+	}
+
+	double b = x + 1.0 - a;
+	double c = 1.0 / tiny;
+	double d = 1.0 / b;
+	double h = d;
+
+	for (int i = 1; i < iterationNum; i++)
+	{
+		double an = -i * (i - a);
+		b += 2.0;
+		d = an * d + b;
+		d = (std::abs(d) < tiny) ? tiny : d;
+		c = b + an / c;
+		c = (std::abs(c) < tiny) ? tiny : c;
+		d = 1.0 / d;
+		h *= d * c;
+		if (std::abs(d * c - 1.0) < epsilon)
+		{
+			break;
+		}
+	}
+	return exp(-x + a * log(x) - lgamma(a)) * h;
+}
+
+static double calcChiSquare(const long long* observed, const double* probabilities, int categoryNum, long long total)
+{
+	double chi = 0.0;
+
+	for (int i = 0; i < categoryNum; i++)
+	{
+		double expected = total * probabilities[i];
+		chi += (observed[i] - expected) * (observed[i] - expected) / expected;
+	}
+
+	return chi;
+}
+
+
+static void calcGramSchmidt(const long long basis[][3], int dimension, long double mu[][3], long double* norms)
+{
+	long double orthogonal[3][3];
+
+	for (int i = 0; i < dimension; i++)
+	{
+		for (int k = 0; k < dimension; k++)
+		{
+			orthogonal[i][k] = (long double)basis[i][k];
+		}
+		for (int j = 0; j < i; j++)
+		{
+			long double dot = 0.0;
+			for (int k = 0; k < dimension; k++)
+			{
+				dot += (long double)basis[i][k] * orthogonal[j][k];
+			}
+			mu[i][j] = dot / norms[j];
+			for (int k = 0; k < dimension; k++)
+			{
+				orthogonal[i][k] -= mu[i][j] * orthogonal[j][k];
+			}
+		}
+
+		norms[i] = 0.0;
+		for (int k = 0; k < dimension; k++)
+		{
+			norms[i] += orthogonal[i][k] * orthogonal[i][k];
+		}
+	}
+}
+
+// Spectral test: nu_t is the length of the shortest nonzero vector (s_1, ..., s_t) with
+// s_1 + s_2 * a + ... + s_t * a^(t-1) = 0 (mod m), and 1 / nu_t is the largest distance
+// between the hyperplanes covering the points (x_n, ..., x_(n+t-1)). The dual lattice is
+// LLL-reduced and the shortest vector is searched among small combinations of the basis.
+static double calcSpectralNu(long long module, long long multiplier, int dimension)
+{
+	const int coefficientRange = 3;
+	long long basis[3][3] = {};
+	long double mu[3][3];
+	long double norms[3];
+	long long power = 1;
+
+	basis[0][0] = module;
+	for (int i = 1; i < dimension; i++)
+	{
+		power = (power * (multiplier % module)) % module;
+		basis[i][0] = -power;
+		basis[i][i] = 1;
+	}
+
+	calcGramSchmidt(basis, dimension, mu, norms);
+	for (int k = 1; k < dimension; )
+	{
+		for (int j = k - 1; j >= 0; j--)
+		{
+			long long q = std::llround(mu[k][j]);
+			if (q != 0)
+			{
+				for (int i = 0; i < dimension; i++)
+				{
+					basis[k][i] -= q * basis[j][i];
+				}
+				calcGramSchmidt(basis, dimension, mu, norms);
+			}
+		}
+
+		if (norms[k] >= (0.99L - mu[k][k - 1] * mu[k][k - 1]) * norms[k - 1])
+		{
+			k++;
+		}
+		else
+		{
+			std::swap(basis[k], basis[k - 1]);
+			calcGramSchmidt(basis, dimension, mu, norms);
+			k = std::max(k - 1, 1);
+		}
+	}
+
+	long double best = -1.0;
+	int coefficients[3] = {-coefficientRange, -coefficientRange, -coefficientRange};
+	while (coefficients[dimension - 1] <= coefficientRange)
+	{
+		long double norm = 0.0;
+		bool isZero = true;
+		for (int i = 0; i < dimension; i++)
+		{
+			long double coordinate = 0.0;
+			for (int j = 0; j < dimension; j++)
+			{
+				coordinate += (long double)coefficients[j] * basis[j][i];
+			}
+			norm += coordinate * coordinate;
+			isZero = isZero && coefficients[i] == 0;
+		}
+		if (!isZero && (best < 0.0 || norm < best))
+		{
+			best = norm;
+		}
+
+		for (int i = 0; i < dimension && ++coefficients[i] > coefficientRange && i < dimension - 1; i++)
+		{
+			coefficients[i] = -coefficientRange;
+		}
+	}
+
+	return sqrt((double)best);
+}
+
+
+UniformBattery::UniformBattery(const MultiplicativePRNG* prng, long long num, int threadNum)
+	: prng(prng->clone()), period(prng->calcPeriod()), requestedNum(num),
+	num((prng->calcPeriod() > 0) ? std::min(num, prng->calcPeriod()) : num), threadNum(std::max(threadNum, 1)) {}
+
+UniformBattery::~UniformBattery()
+{
+	delete prng;
+}
+
+
+// Pairs (i, i + lag) and the runs transition (i, i + 1) belong to the block holding i,
+// which is why the pass runs up to BATTERY_HISTORY_SIZE values past the block end.
+void UniformBattery::processBlock(BatteryBlock* block) const
+{
+	MultiplicativePRNG* generator = prng->clone();
+	long long history[BATTERY_HISTORY_SIZE];
+	const long long module = generator->getModule();
+	const long long stop = std::min(num, block->end + BATTERY_HISTORY_SIZE);
+	int bitNum = 0;
+	bool prevAbove = false;
+	int handMask = 0;
+	long long gap = 0;
+
+	while (bitNum < BATTERY_MAX_BITS && (1LL << (bitNum + 1)) <= module)
+	{
+		bitNum++;
+	}
+
+	generator->skip(block->begin);
+
+	for (long long j = block->begin; j < stop; j++)
+	{
+		long long raw = generator->nextInteger();
+		double value = (double)raw / module;
+		long long centered = 2 * raw - module;
+		bool isAbove = (value >= 0.5);
+
+		for (int l = 0; l < BATTERY_LAG_NUM; l++)
+		{
+			long long i = j - lags[l];
+			if (i >= block->begin && i < block->end)
+			{
+				addExact(&block->lagSums[l], history[i % BATTERY_HISTORY_SIZE] * centered);
+				block->lagCounts[l]++;
+			}
+		}
+		history[j % BATTERY_HISTORY_SIZE] = centered;
+
+		if (j > block->begin && j - 1 < block->end && isAbove != prevAbove)
+		{
+			block->transitionNum++;
+		}
+		prevAbove = isAbove;
+
+		if (j >= block->end)
+		{
+			continue;
+		}
+
+		block->aboveNum += isAbove;
+
+		if (value >= BATTERY_GAP_LEFT && value < BATTERY_GAP_RIGHT)
+		{
+			if (block->hasHit)
+			{
+				block->gapCounts[std::min(gap, (long long)BATTERY_GAP_LENGTHS)]++;
+			}
+			else
+			{
+				block->leadingGap = gap;
+				block->hasHit = true;
+			}
+			gap = 0;
+		}
+		else
+		{
+			gap++;
+		}
+
+		handMask |= 1 << (int)(value * BATTERY_POKER_DIGITS);
+		if (j % BATTERY_POKER_HAND == BATTERY_POKER_HAND - 1)
+		{
+			int distinct = 0;
+			for (int d = 0; d < BATTERY_POKER_DIGITS; d++)
+			{
+				distinct += (handMask >> d) & 1;
+			}
+			block->pokerCounts[distinct]++;
+			handMask = 0;
+		}
+
+		for (int b = 0; b < bitNum; b++)
+		{
+			block->bitCounts[b] += (raw >> b) & 1;
+		}
+	}
+
+	block->trailingGap = gap;
+
+	delete generator;
+}
+
+void UniformBattery::run(FILE* outputFile) const
+{
+	// Blocks start at multiples of the poker hand size, so no hand is split between threads.
+	long long blockSize = (num / threadNum + BATTERY_POKER_HAND) / BATTERY_POKER_HAND * BATTERY_POKER_HAND;
+	std::vector<BatteryBlock> blocks(threadNum);
+	std::vector<std::thread> threads;
+	const long long module = prng->getModule();
+	int bitNum = 0;
+
+	while (bitNum < BATTERY_MAX_BITS && (1LL << (bitNum + 1)) <= module)
+	{
+		bitNum++;
+	}
+
+	for (int t = 0; t < threadNum; t++)
+	{
+		blocks[t] = BatteryBlock();
+		blocks[t].begin = std::min(num, t * blockSize);
+		blocks[t].end = std::min(num, (t + 1) * blockSize);
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int t = 0; t < threadNum; t++)
+	{
+		threads.push_back(std::thread(&UniformBattery::processBlock, this, &blocks[t]));
+	}
+	for (int t = 0; t < threadNum; t++)
+	{
+		threads[t].join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	BatteryBlock total = BatteryBlock();
+	long long pendingGap = 0;
+	bool hasHit = false;
+
+	for (int t = 0; t < threadNum; t++)
+	{
+		const BatteryBlock& block = blocks[t];
+
+		for (int l = 0; l < BATTERY_LAG_NUM; l++)
+		{
+			mergeExact(&total.lagSums[l], block.lagSums[l]);
+			total.lagCounts[l] += block.lagCounts[l];
+		}
+		total.aboveNum += block.aboveNum;
+		total.transitionNum += block.transitionNum;
+		for (int r = 0; r <= BATTERY_POKER_HAND; r++)
+		{
+			total.pokerCounts[r] += block.pokerCounts[r];
+		}
+		for (int b = 0; b < bitNum; b++)
+		{
+			total.bitCounts[b] += block.bitCounts[b];
+		}
+
+		if (!block.hasHit)
+		{
+			pendingGap += block.end - block.begin;
+			continue;
+		}
+		if (hasHit)
+		{
+			total.gapCounts[std::min(pendingGap + block.leadingGap, (long long)BATTERY_GAP_LENGTHS)]++;
+		}
+		for (int r = 0; r <= BATTERY_GAP_LENGTHS; r++)
+		{
+			total.gapCounts[r] += block.gapCounts[r];
+		}
+		pendingGap = block.trailingGap;
+		hasHit = true;
+	}
+
+	printf("Uniform battery: %lld values, %d threads\n", num, threadNum);
+	fprintf(outputFile, "Uniform battery: %lld values, %d threads\n", num, threadNum);
+	printf("Period: %lld\n", period);
+	fprintf(outputFile, "Period: %lld\n", period);
+	if (requestedNum > num)
+	{
+		printf("Warning: %lld values requested, cut down to one period\n", requestedNum);
+		fprintf(outputFile, "Warning: %lld values requested, cut down to one period\n", requestedNum);
+	}
+	printf("Throughput: %.2f M values/s (%.3f s)\n", num / seconds / 1e6, seconds);
+	fprintf(outputFile, "Throughput: %.2f M values/s (%.3f s)\n", num / seconds / 1e6, seconds);
+
+	// Centered products y_i * y_(i+lag) are uncorrelated with variance 1/144 under H0. The
+	// sums are taken exactly over c = 2 * raw - module = 2 * module * y, so they do not
+	// depend on how the stream was split between threads.
+	for (int l = 0; l < BATTERY_LAG_NUM; l++)
+	{
+		char name[64];
+		double z = 3.0 * convertExact(total.lagSums[l]) / ((double)module * module) / sqrt((double)total.lagCounts[l]);
+
+		snprintf(name, sizeof(name), "Serial correlation, lag %d", lags[l]);
+		printResult(outputFile, name, z, calcNormalPValue(z));
+	}
+
+	// Wald-Wolfowitz runs above and below 0.5.
+	{
+		double above = (double)total.aboveNum;
+		double below = (double)(num - total.aboveNum);
+		double runs = total.transitionNum + 1.0;
+		double expected = 2.0 * above * below / num + 1.0;
+		double variance = 2.0 * above * below * (2.0 * above * below - num) / ((double)num * num * (num - 1.0));
+		double z = (runs - expected) / sqrt(variance);
+
+		printResult(outputFile, "Runs", z, calcNormalPValue(z));
+	}
+
+	{
+		double probabilities[BATTERY_GAP_LENGTHS + 1];
+		double p = BATTERY_GAP_RIGHT - BATTERY_GAP_LEFT;
+		long long gapNum = 0;
+
+		for (int r = 0; r < BATTERY_GAP_LENGTHS; r++)
+		{
+			probabilities[r] = p * pow(1.0 - p, r);
+		}
+		probabilities[BATTERY_GAP_LENGTHS] = pow(1.0 - p, BATTERY_GAP_LENGTHS);
+		for (int r = 0; r <= BATTERY_GAP_LENGTHS; r++)
+		{
+			gapNum += total.gapCounts[r];
+		}
+
+		double chi = calcChiSquare(total.gapCounts, probabilities, BATTERY_GAP_LENGTHS + 1, gapNum);
+		printResult(outputFile, "Gap", chi, calcGammaQ(BATTERY_GAP_LENGTHS / 2.0, chi / 2.0));
+	}
+
+	// Hands with one or two distinct digits are pooled to keep the expected counts large.
+	{
+		const double stirling[BATTERY_POKER_HAND + 1] = {0.0, 1.0, 15.0, 25.0, 10.0, 1.0};
+		double probabilities[BATTERY_POKER_HAND];
+		long long observed[BATTERY_POKER_HAND];
+		long long handNum = 0;
+
+		for (int r = 1; r <= BATTERY_POKER_HAND; r++)
+		{
+			double falling = 1.0;
+			for (int i = 0; i < r; i++)
+			{
+				falling *= BATTERY_POKER_DIGITS - i;
+			}
+			probabilities[r - 1] = stirling[r] * falling / pow(BATTERY_POKER_DIGITS, BATTERY_POKER_HAND);
+			observed[r - 1] = total.pokerCounts[r];
+			handNum += total.pokerCounts[r];
+		}
+		probabilities[1] += probabilities[0];
+		observed[1] += observed[0];
+
+		double chi = calcChiSquare(&observed[1], &probabilities[1], BATTERY_POKER_HAND - 1, handNum);
+		printResult(outputFile, "Poker", chi, calcGammaQ((BATTERY_POKER_HAND - 2) / 2.0, chi / 2.0));
+	}
+
+	for (int b = 0; b < bitNum; b++)
+	{
+		char name[64];
+		double z = (2.0 * total.bitCounts[b] - num) / sqrt((double)num);
+
+		snprintf(name, sizeof(name), "Bit %d frequency", b);
+		printResult(outputFile, name, z, calcNormalPValue(z));
+	}
+
+	for (int dimension = 2; dimension <= 3; dimension++)
+	{
+		double nu = calcSpectralNu(module, prng->getMultiplier(), dimension);
+		double merit = (dimension == 2) ? M_PI * nu * nu / module : 4.0 / 3.0 * M_PI * nu * nu * nu / module;
+
+		printf("Spectral test, %dD          nu %12.4f  merit %.6f\n", dimension, nu, merit);
+		fprintf(outputFile, "Spectral test, %dD          nu %12.4f  merit %.6f\n", dimension, nu, merit);
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdio>
+#include "MultiplicativePRNG.h"
+
+#define BATTERY_LAG_NUM         8
+#define BATTERY_HISTORY_SIZE    64
+#define BATTERY_GAP_LEFT        0.25
+#define BATTERY_GAP_RIGHT       0.5
+#define BATTERY_GAP_LENGTHS     24
+#define BATTERY_POKER_DIGITS    8
+#define BATTERY_POKER_HAND      5
+#define BATTERY_MAX_BITS        62
+
+struct BatteryBlock;
+
+
+// Empirical tests of the uniform stream of a MultiplicativePRNG, starting from its current
+// state. The stream is cut into one contiguous block per thread; every thread jumps its own
+// copy of the generator to the start of its block and makes a single pass over it, reading
+// a few values past the end for the pairs that cross into the next block. The partial
+// counts and the exact integer lag sums are merged in block order, so the results do not
+// depend on the number of threads. A request for more values than one period of the
+// generator is cut down to the period: the values past it would only repeat the stream.
+// The lag sums assume a module of at most 2^31, so every product fits in 63 bits.
+class UniformBattery
+{
+private:
+	const MultiplicativePRNG* prng;
+	const long long period;
+	const long long requestedNum;
+	const long long num;
+	const int threadNum;
+
+	void processBlock(BatteryBlock* block) const;
+public:
+	UniformBattery(const MultiplicativePRNG* prng, long long num, int threadNum);
+	~UniformBattery();
+
+	void run(FILE* outputFile) const;
+};